@@ -0,0 +1,579 @@
+/*==============================================================================
+*  This file is part of GPSTk, the GPS Toolkit.
+*
+*  Copyright (C/C++) 2020, Beihang University All Rights Reserved.
+*
+*  Author: agent, E-mail:agent@local
+*
+*  version: $Revision 1.0 $Data: 2026/10/18 00:00:00 $
+*
+*  history: 2026/10/18 	1.0 new
+						void	setreftime(gtime_t t);
+						void	setrcv(int rcv);
+						int		inputbuf(const unsigned char *buff, int n, int *nused);
+						obsd_t* getobs(int *n);
+						int		getcrcerr(void);
+*
+*  references :
+*      [1] RTCM Standard 10403.3, Differential GNSS (Global Navigation
+*          Satellite Systems) Services - version 3, October 7, 2016
+*==============================================================================*/
+/**
+ * @file rtcm.cpp
+ * streaming rtcm 3 msm (msm4-msm7) decoder for gps, galileo and beidou.
+ */
+
+#include <cstring>
+#include <ctime>
+
+#include "constant.h"
+#include "rtcm.h"
+#include "math.h"
+
+#if !defined(NFREQ)||!defined(MAXSAT)||!defined(MAXOBS)||!defined(CLIGHT)
+#error "constant.h must define NFREQ, MAXSAT, MAXOBS and CLIGHT"
+#endif
+#if !defined(NSATGPS)||!defined(NSATGLO)||!defined(NSATGAL)||!defined(NSATQZS)||!defined(NSATCMP)
+#error "constant.h must define NSATGPS, NSATGLO, NSATGAL, NSATQZS and NSATCMP"
+#endif
+#if !defined(SYS_GPS)||!defined(SYS_GAL)||!defined(SYS_CMP)
+#error "constant.h must define SYS_GPS, SYS_GAL and SYS_CMP"
+#endif
+#if !defined(FREQ1)||!defined(FREQ2)||!defined(FREQ5)||!defined(FREQ6)||!defined(FREQ7)|| \
+	!defined(FREQ8)||!defined(FREQ1_CMP)||!defined(FREQ2_CMP)||!defined(FREQ3_CMP)
+#error "constant.h must define FREQ1,2,5,6,7,8 and FREQ1_CMP,FREQ2_CMP,FREQ3_CMP"
+#endif
+#if !defined(CODE_L1C)||!defined(CODE_L1P)||!defined(CODE_L1W)||!defined(CODE_L1S)|| \
+	!defined(CODE_L1L)||!defined(CODE_L1A)||!defined(CODE_L1B)||!defined(CODE_L1X)|| \
+	!defined(CODE_L1Z)||!defined(CODE_L2C)||!defined(CODE_L2S)||!defined(CODE_L2L)|| \
+	!defined(CODE_L2X)||!defined(CODE_L2P)||!defined(CODE_L2W)||!defined(CODE_L2I)|| \
+	!defined(CODE_L2Q)||!defined(CODE_L5I)||!defined(CODE_L5Q)||!defined(CODE_L5X)|| \
+	!defined(CODE_L6A)||!defined(CODE_L6B)||!defined(CODE_L6C)||!defined(CODE_L6X)|| \
+	!defined(CODE_L6Z)||!defined(CODE_L6I)||!defined(CODE_L6Q)||!defined(CODE_L7I)|| \
+	!defined(CODE_L7Q)||!defined(CODE_L7X)||!defined(CODE_L8I)||!defined(CODE_L8Q)|| \
+	!defined(CODE_L8X)
+#error "constant.h must define the CODE_??? obs codes of gps, galileo and beidou"
+#endif
+
+#define RTCM3PREAMB	0xD3			/* rtcm ver.3 frame preamble */
+#define RANGE_MS	(CLIGHT*0.001)	/* range in 1 ms */
+#define P2_10		0.0009765625	/* 2^-10 */
+#define P2_24		5.960464477539063E-08 /* 2^-24 */
+#define P2_29		1.862645149230957E-09 /* 2^-29 */
+#define P2_31		4.656612873077393E-10 /* 2^-31 */
+
+#define MSM_HDRBITS	(24+169)		/* frame header + msm header up to masks (bits) */
+#define MSM_FLUSH	2				/* decode status: previous epoch flushed, frame kept */
+
+namespace gpstk
+{
+
+	struct sigtbl_t{		/* msm signal id to obs code and frequency */
+		unsigned char code;	/* code indicator (CODE_???) */
+		unsigned char idx;	/* frequency index of obsd_t */
+		unsigned char pri;	/* priority within the frequency (higher first) */
+		double freq;		/* carrier frequency (Hz) (0: not supported) */
+	};
+
+	/* msm signal id (1-32) tables, ref [1] table 3.5-91,-99,-108 ------------------
+	* priorities: L1 C>P>W>S>L>X, L2 P>W>C>S>L>X, E1 C>A>B>X>Z, E6 A>B>C>X>Z,
+	*             others I>Q>X
+	*-----------------------------------------------------------------------------*/
+	static const sigtbl_t sig_gps[RTCM_NSIG]={
+		{0,0,0,0.0},{CODE_L1C,0,8,FREQ1},{CODE_L1P,0,7,FREQ1},{CODE_L1W,0,5,FREQ1},
+		{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},{CODE_L2C,1,7,FREQ2},
+		{CODE_L2P,1,10,FREQ2},{CODE_L2W,1,8,FREQ2},{0,0,0,0.0},{0,0,0,0.0},
+		{0,0,0,0.0},{0,0,0,0.0},{CODE_L2S,1,4,FREQ2},{CODE_L2L,1,3,FREQ2},
+		{CODE_L2X,1,2,FREQ2},{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},
+		{0,0,0,0.0},{CODE_L5I,2,3,FREQ5},{CODE_L5Q,2,2,FREQ5},{CODE_L5X,2,1,FREQ5},
+		{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},
+		{0,0,0,0.0},{CODE_L1S,0,3,FREQ1},{CODE_L1L,0,2,FREQ1},{CODE_L1X,0,1,FREQ1}
+	};
+	static const sigtbl_t sig_gal[RTCM_NSIG]={
+		{0,0,0,0.0},{CODE_L1C,0,5,FREQ1},{CODE_L1A,0,4,FREQ1},{CODE_L1B,0,3,FREQ1},
+		{CODE_L1X,0,2,FREQ1},{CODE_L1Z,0,1,FREQ1},{0,0,0,0.0},{CODE_L6C,3,3,FREQ6},
+		{CODE_L6A,3,5,FREQ6},{CODE_L6B,3,4,FREQ6},{CODE_L6X,3,2,FREQ6},{CODE_L6Z,3,1,FREQ6},
+		{0,0,0,0.0},{CODE_L7I,1,3,FREQ7},{CODE_L7Q,1,2,FREQ7},{CODE_L7X,1,1,FREQ7},
+		{0,0,0,0.0},{CODE_L8I,4,3,FREQ8},{CODE_L8Q,4,2,FREQ8},{CODE_L8X,4,1,FREQ8},
+		{0,0,0,0.0},{CODE_L5I,2,3,FREQ5},{CODE_L5Q,2,2,FREQ5},{CODE_L5X,2,1,FREQ5},
+		{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},
+		{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0}
+	};
+	static const sigtbl_t sig_cmp[RTCM_NSIG]={
+		{0,0,0,0.0},{CODE_L2I,0,3,FREQ1_CMP},{CODE_L2Q,0,2,FREQ1_CMP},{CODE_L2X,0,1,FREQ1_CMP},
+		{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},{CODE_L6I,2,3,FREQ3_CMP},
+		{CODE_L6Q,2,2,FREQ3_CMP},{CODE_L6X,2,1,FREQ3_CMP},{0,0,0,0.0},{0,0,0,0.0},
+		{0,0,0,0.0},{CODE_L7I,1,3,FREQ2_CMP},{CODE_L7Q,1,2,FREQ2_CMP},{CODE_L7X,1,1,FREQ2_CMP},
+		{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},
+		{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},
+		{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},
+		{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0},{0,0,0,0.0}
+	};
+
+	/* crc-24q table -------------------------------------------------------------*/
+	struct crctbl_t{
+		unsigned int tbl[256];
+		crctbl_t(){
+			for (unsigned int i=0;i<256;i++) {
+				unsigned int c=i<<16;
+				for (int j=0;j<8;j++) {
+					c<<=1; if (c&0x1000000) c^=0x1864CFB;
+				}
+				tbl[i]=c&0xFFFFFF;
+			}
+		}
+	};
+
+	/* extract unsigned/signed bits ------------------------------------------------
+	* extract unsigned/signed bits from byte data
+	* args   : unsigned char *buff I byte data
+	*          int    pos    I      bit position from start of data (bits)
+	*          int    len    I      bit length (bits) (len<=32)
+	* return : extracted unsigned/signed bits
+	* notes  : reads the covering bytes at once instead of bit by bit
+	*-----------------------------------------------------------------------------*/
+	static unsigned int getbitu(const unsigned char *buff, int pos, int len)
+	{
+		unsigned long long bits=0;
+		int i,n=(pos+len+7)>>3;
+
+		for (i=pos>>3;i<n;i++) bits=(bits<<8)|buff[i];
+		return (unsigned int)((bits>>((n<<3)-pos-len))&((1ULL<<len)-1));
+	}
+	static int getbits(const unsigned char *buff, int pos, int len)
+	{
+		unsigned int bits=getbitu(buff,pos,len);
+		if (len<=0||32<=len||!(bits&(1u<<(len-1)))) return (int)bits;
+		return (int)(bits|(~0u<<len)); /* extend sign */
+	}
+
+	/* crc-24q parity --------------------------------------------------------------
+	* compute crc-24q parity for rtcm 3, ref [1] 4.2
+	* args   : unsigned char *buff I data
+	*          int    len    I      data length (bytes)
+	* return : crc-24q parity
+	*-----------------------------------------------------------------------------*/
+	static unsigned int crc24q(const unsigned char *buff, int len)
+	{
+		static const crctbl_t crc; /* built once on first call */
+		unsigned int c=0;
+
+		for (int i=0;i<len;i++) c=((c<<8)&0xFFFFFF)^crc.tbl[(c>>16)^buff[i]];
+		return c;
+	}
+
+	/* satellite system+prn to satellite number ----------------------------------*/
+	static int satno(int sys, int prn)
+	{
+		if (prn<=0) return 0;
+		switch (sys) {
+			case SYS_GPS:
+				return prn>NSATGPS?0:prn;
+			case SYS_GAL:
+				return prn>NSATGAL?0:NSATGPS+NSATGLO+prn;
+			case SYS_CMP:
+				return prn>NSATCMP?0:NSATGPS+NSATGLO+NSATGAL+NSATQZS+prn;
+		}
+		return 0;
+	}
+
+	/* msm lock time indicator to lock time ----------------------------------------
+	* convert msm lock time indicator to minimum lock time
+	* args   : int    lock      I   lock time indicator (DF402 or DF407)
+	*          int    msm       I   msm type (4-7)
+	* return : minimum lock time (ms) (0: reserved indicator)
+	* notes  : ref [1] table 3.5-74,-75. DF407 steps 2^k ms in range
+	*          [32(k+1),32(k+2)) with lock time 2^k*(lock-32k) for lock>=64
+	*-----------------------------------------------------------------------------*/
+	static double locktime(int lock, int msm)
+	{
+		int k;
+
+		if (msm==4||msm==5) return lock?ldexp(1.0,lock+4):0.0;
+
+		if (lock<64) return lock;
+		if (lock>704) return 0.0;
+		k=lock/32-1;
+		return ldexp((double)(lock-32*k),k);
+	}
+
+	rtcm_t::rtcm_t(){  /* constructor */
+
+		gtime_t now={std::time(NULL),0.0};
+
+		this->mref=this->mtime.utc2gpst(now); /* system clock until set */
+		this->mrcv=1;
+		this->mn=this->mflag=0;
+		this->mnbyte=0;
+		this->mncrc=0;
+		memset(this->mobs,0,sizeof(this->mobs));
+		memset(this->mlock,0,sizeof(this->mlock));
+	}
+
+	/* set reference time ----------------------------------------------------------
+	* set approximate gps time used to resolve the week of msm time of week
+	* args   : gtime_t t        I   approximate time (GPST) within +-3.5 days
+	* return : none
+	* notes  : required for file replay, the system clock is used by default.
+	*          the reference follows the decoded epochs afterwards
+	*-----------------------------------------------------------------------------*/
+	void rtcm_t::setreftime(gtime_t t)
+	{
+		this->mref=t;
+	}
+
+	/* set receiver number of decoded observation data ---------------------------*/
+	void rtcm_t::setrcv(int rcv)
+	{
+		this->mrcv=rcv;
+	}
+
+	/* get number of crc errors --------------------------------------------------*/
+	int rtcm_t::getcrcerr(void)
+	{
+		return this->mncrc;
+	}
+
+	/* get observation data of complete epoch --------------------------------------
+	* get the observation data of the epoch completed by the last inputbuf()
+	* args   : int    *n        O   number of observation data (0: no epoch)
+	* return : observation data of the epoch (valid until next inputbuf())
+	*-----------------------------------------------------------------------------*/
+	obsd_t* rtcm_t::getobs(int *n)
+	{
+		*n=this->mflag?this->mn:0;
+		return this->mobs;
+	}
+
+	/* input rtcm 3 stream ---------------------------------------------------------
+	* input a chunk of rtcm 3 byte stream (file replay or socket read)
+	* args   : unsigned char *buff I stream bytes (any chunking)
+	*          int    n         I   number of bytes
+	*          int    *nused    O   number of bytes consumed (NULL: no output)
+	* return : status (1: epoch complete, see getobs(), 0: need more bytes)
+	* notes  : input stops after an epoch is complete, so the caller has to
+	*          input buff+*nused again. frames contained in the chunk are
+	*          decoded in place, only frames split across chunks are copied.
+	*          on a crc error the stream is searched again for the preamble
+	*          from the next byte of the bad frame.
+	*          a frame of the next epoch completing the buffered epoch (lost
+	*          sync=0 message) is not consumed and decoded by next input.
+	*-----------------------------------------------------------------------------*/
+	int rtcm_t::inputbuf(const unsigned char *buff, int n, int *nused)
+	{
+		int i=0,k,len,stat;
+
+		/* frames left in frame buffer by previous input */
+		stat=decode_buff();
+
+		while (i<n&&!stat) {
+
+			if (this->mnbyte==0) {
+				if (buff[i]!=RTCM3PREAMB) {i++; continue;}
+
+				/* complete frame in input: decode in place */
+				if (n-i>=3) {
+					len=(int)getbitu(buff+i,14,10)+3;
+					if (n-i>=len+3) {
+						if (crc24q(buff+i,len)!=getbitu(buff+i,len*8,24)) {
+							this->mncrc++; i++; continue;
+						}
+						if ((stat=decode(buff+i,len))!=MSM_FLUSH) i+=len+3;
+						if (stat<0) stat=0;
+						continue;
+					}
+				}
+			}
+			/* frame split across inputs: copy up to the end of the frame */
+			if (this->mnbyte<3) len=3;
+			else len=(int)getbitu(this->mbuff,14,10)+6;
+			k=len-this->mnbyte<n-i?len-this->mnbyte:n-i;
+			memcpy(this->mbuff+this->mnbyte,buff+i,k);
+			this->mnbyte+=k; i+=k;
+
+			/* frame of next epoch: leave its last byte to decode it by next input */
+			if ((stat=decode_buff())==MSM_FLUSH) {this->mnbyte--; i--;}
+		}
+		if (nused) *nused=i;
+		return stat?1:0;
+	}
+
+	/* decode frames in frame buffer -----------------------------------------------
+	* decode complete frames in frame buffer, resync from the next byte on a
+	* crc error as the in place path does
+	* args   : none
+	* return : status (1: epoch complete, 0: need more bytes,
+	*                  MSM_FLUSH: previous epoch complete, frame kept)
+	*-----------------------------------------------------------------------------*/
+	int rtcm_t::decode_buff(void)
+	{
+		int i,len,stat;
+
+		while (this->mnbyte>0) {
+
+			/* search preamble */
+			for (i=0;i<this->mnbyte;i++) if (this->mbuff[i]==RTCM3PREAMB) break;
+			if (i>0) {
+				this->mnbyte-=i;
+				memmove(this->mbuff,this->mbuff+i,this->mnbyte);
+				continue;
+			}
+			if (this->mnbyte<3) return 0;
+			len=(int)getbitu(this->mbuff,14,10)+3;
+			if (this->mnbyte<len+3) return 0;
+
+			if (crc24q(this->mbuff,len)!=getbitu(this->mbuff,len*8,24)) {
+				this->mncrc++; len=1; stat=0;
+			}
+			else if ((stat=decode(this->mbuff,len))==MSM_FLUSH) {
+				return MSM_FLUSH; /* keep frame for next input */
+			}
+			else len+=3;
+
+			this->mnbyte-=len;
+			memmove(this->mbuff,this->mbuff+len,this->mnbyte);
+			if (stat==1) return 1;
+		}
+		return 0;
+	}
+
+	/* decode rtcm 3 frame ----------------------------------------------------------
+	* decode msm4-msm7 of gps, galileo and beidou. other msm (1071-1137) are
+	* only used for the epoch time and the multiple message bit
+	* args   : unsigned char *buff I rtcm 3 frame (without crc)
+	*          int    len       I   frame length (bytes)
+	* return : status (see decode_msm())
+	*-----------------------------------------------------------------------------*/
+	int rtcm_t::decode(const unsigned char *buff, int len)
+	{
+		int type,msm;
+
+		if (len<5) return -1; /* no message number */
+
+		type=(int)getbitu(buff,24,12); msm=type%10;
+
+		if (type<1071||1137<type||msm<1||7<msm) return 0; /* not msm */
+
+		if (msm>=4) switch (type/10) {
+			case 107: return decode_msm(buff,len,SYS_GPS,msm);
+			case 109: return decode_msm(buff,len,SYS_GAL,msm);
+			case 112: return decode_msm(buff,len,SYS_CMP,msm);
+		}
+		return decode_sync(buff,len,type/10==108);
+	}
+
+	/* decode epoch time and sync of other msm -------------------------------------
+	* complete the buffered epoch by msm of a system not decoded (glonass,
+	* sbas, qzss, navic or msm1-3), which can be the last message of an epoch
+	* args   : unsigned char *buff I rtcm 3 frame (without crc)
+	*          int    len       I   frame length (bytes)
+	*          int    glo       I   glonass epoch time (day of week + time of day)
+	* return : status (see decode_msm())
+	*-----------------------------------------------------------------------------*/
+	int rtcm_t::decode_sync(const unsigned char *buff, int len, int glo)
+	{
+		int i=24+12+12,sync;
+		gtime_t t;
+
+		if (len*8<i+31) return -1;
+
+		if (glo) t=adjday(getbitu(buff,i+3,27)*0.001);
+		else     t=adjweek(SYS_GPS,getbitu(buff,i,30)*0.001); /* gps aligned tow */
+		sync=getbitu(buff,i+30,1);
+
+		if (this->mflag||this->mn<=0) return 0;
+
+		if (fabs(this->mtime.timediff(this->mobs[0].time,t))>1E-9) {
+			this->mflag=1;
+			return MSM_FLUSH;
+		}
+		if (!sync) this->mflag=1; /* last message of the epoch */
+
+		return this->mflag;
+	}
+
+	/* adjust week of time of week -------------------------------------------------
+	* resolve the week of msm epoch time by the reference time
+	* args   : int    sys       I   navigation system (SYS_???)
+	*          double tow       I   time of week in system time (s)
+	* return : gtime_t struct (GPST)
+	*-----------------------------------------------------------------------------*/
+	gtime_t rtcm_t::adjweek(int sys, double tow)
+	{
+		double tow_p;
+		int week;
+
+		if      (sys==SYS_GAL) tow_p=this->mtime.time2gst(this->mref,&week);
+		else if (sys==SYS_CMP) tow_p=this->mtime.time2bdt(this->mtime.gpst2bdt(this->mref),&week);
+		else                   tow_p=this->mtime.time2gpst(this->mref,&week);
+
+		if      (tow<tow_p-302400.0) week++;
+		else if (tow>tow_p+302400.0) week--;
+
+		if (sys==SYS_GAL) return this->mtime.gst2time(week,tow);
+		if (sys==SYS_CMP) return this->mtime.bdt2gpst(this->mtime.bdt2time(week,tow));
+		return this->mtime.gpst2time(week,tow);
+	}
+
+	/* adjust day of glonass time of day ------------------------------------------
+	* resolve the day of glonass time of day by the reference time
+	* args   : double tod       I   time of day in glonass time (UTC+3h) (s)
+	* return : gtime_t struct (GPST)
+	*-----------------------------------------------------------------------------*/
+	gtime_t rtcm_t::adjday(double tod)
+	{
+		gtime_t t=this->mtime.timeadd(this->mtime.gpst2utc(this->mref),10800.0);
+		double tow,tod_p;
+		int week;
+
+		tow=this->mtime.time2gpst(t,&week);
+		tod_p=fmod(tow,86400.0); tow-=tod_p;
+
+		if      (tod<tod_p-43200.0) tod+=86400.0;
+		else if (tod>tod_p+43200.0) tod-=86400.0;
+
+		t=this->mtime.gpst2time(week,tow+tod);
+		return this->mtime.utc2gpst(this->mtime.timeadd(t,-10800.0));
+	}
+
+	/* decode msm4-msm7 ------------------------------------------------------------
+	* decode msm message into the observation data of current epoch, ref [1] 3.5.16
+	* args   : unsigned char *buff I rtcm 3 frame (without crc)
+	*          int    len       I   frame length (bytes)
+	*          int    sys       I   navigation system (SYS_???)
+	*          int    msm       I   msm type (4-7)
+	* return : status (-1: error, 0: no epoch, 1: epoch complete,
+	*                  MSM_FLUSH: previous epoch complete, message not decoded)
+	* notes  : an epoch is also completed by a message of a new epoch time
+	*          in case the last message of the epoch (sync=0) was lost.
+	*          each obsd_t frequency holds the highest priority signal only
+	*-----------------------------------------------------------------------------*/
+	int rtcm_t::decode_msm(const unsigned char *buff, int len, int sys, int msm)
+	{
+		const sigtbl_t *tbl=sys==SYS_GAL?sig_gal:(sys==SYS_CMP?sig_cmp:sig_gps);
+		const sigtbl_t *sig;
+		double tow,r[64],rr[64],pr[64],cp[64],rrf[64],lock[64],cnr[64],lam,prev;
+		unsigned char half[64],mask[64];
+		int i=24+12,j,k,c,v,f,nsat=0,nsig=0,ncell=0,sync,sat,ext=msm==5||msm==7;
+		int sats[64],sigs[RTCM_NSIG],cell[RTCM_NSIG],best[NFREQ];
+		gtime_t t;
+		obsd_t *obs;
+
+		/* msm header */
+		if (len*8<MSM_HDRBITS) return -1;
+		i+=12; /* reference station id */
+		tow=getbitu(buff,i,30)*0.001; i+=30;
+		sync=getbitu(buff,i,1);       i+=1;
+		i+=3+7+2+2+1+3; /* iods,reserved,clock steering/external,smoothing */
+		for (j=1;j<=64;j++) if (getbitu(buff,i++,1)) sats[nsat++]=j;
+		for (j=1;j<=RTCM_NSIG;j++) if (getbitu(buff,i++,1)) sigs[nsig++]=j;
+		if (nsat*nsig>64||i+nsat*nsig>len*8) return -1;
+		for (j=0;j<nsat*nsig;j++) if ((mask[j]=getbitu(buff,i++,1))) ncell++;
+
+		if (i+nsat*(ext?36:18)+ncell*(msm==4?48:(msm==5?63:(msm==6?65:80)))>len*8) {
+			return -1; /* message length error */
+		}
+		/* complete buffered epoch on a new epoch time */
+		t=adjweek(sys,tow);
+		if (!this->mflag&&this->mn>0&&fabs(this->mtime.timediff(this->mobs[0].time,t))>1E-9) {
+			this->mflag=1;
+			return MSM_FLUSH;
+		}
+		if (this->mflag) this->mn=this->mflag=0;
+		this->mref=t;
+
+		/* satellite data */
+		for (j=0;j<nsat;j++) {
+			v=getbitu(buff,i,8); i+=8;
+			r[j]=v!=255?v*RANGE_MS:0.0;
+			rr[j]=-1E16;
+		}
+		if (ext) i+=4*nsat; /* extended satellite info */
+		for (j=0;j<nsat;j++) {
+			v=getbitu(buff,i,10); i+=10;
+			if (r[j]!=0.0) r[j]+=v*P2_10*RANGE_MS;
+		}
+		if (ext) for (j=0;j<nsat;j++) {
+			v=getbits(buff,i,14); i+=14;
+			if (v!=-8192) rr[j]=v;
+		}
+		/* signal data */
+		for (k=0;k<ncell;k++) {
+			pr[k]=cp[k]=rrf[k]=-1E16;
+		}
+		if (msm==4||msm==5) {
+			for (k=0;k<ncell;k++) {v=getbits(buff,i,15); i+=15; if (v!=-16384  ) pr[k]=v*P2_24;}
+			for (k=0;k<ncell;k++) {v=getbits(buff,i,22); i+=22; if (v!=-2097152) cp[k]=v*P2_29;}
+			for (k=0;k<ncell;k++) {lock[k]=locktime(getbitu(buff,i,4),msm); i+=4;}
+			for (k=0;k<ncell;k++) {half[k]=getbitu(buff,i,1); i+=1;}
+			for (k=0;k<ncell;k++) {cnr[k]=getbitu(buff,i,6); i+=6;}
+		}
+		else {
+			for (k=0;k<ncell;k++) {v=getbits(buff,i,20); i+=20; if (v!=-524288 ) pr[k]=v*P2_29;}
+			for (k=0;k<ncell;k++) {v=getbits(buff,i,24); i+=24; if (v!=-8388608) cp[k]=v*P2_31;}
+			for (k=0;k<ncell;k++) {lock[k]=locktime(getbitu(buff,i,10),msm); i+=10;}
+			for (k=0;k<ncell;k++) {half[k]=getbitu(buff,i,1); i+=1;}
+			for (k=0;k<ncell;k++) {cnr[k]=getbitu(buff,i,10)*0.0625; i+=10;}
+		}
+		if (ext) for (k=0;k<ncell;k++) {
+			v=getbits(buff,i,15); i+=15;
+			if (v!=-16384) rrf[k]=v*0.0001;
+		}
+		for (j=c=0;j<nsat;j++) {
+
+			/* cell index of signals and highest priority signal per frequency */
+			for (f=0;f<NFREQ;f++) best[f]=-1;
+			for (k=0;k<nsig;k++) {
+				cell[k]=mask[j*nsig+k]?c++:-1;
+				sig=tbl+sigs[k]-1;
+				if (cell[k]<0||sig->freq<=0.0||sig->idx>=NFREQ) continue;
+				f=sig->idx;
+				if (best[f]<0||sig->pri>tbl[sigs[best[f]]-1].pri) best[f]=k;
+			}
+			sat=satno(sys,sats[j]);
+			if (sat<=0||MAXSAT<sat) continue;
+
+			/* search or add observation data of the satellite */
+			for (v=0;v<this->mn;v++) if (this->mobs[v].sat==sat) break;
+			if (v==this->mn) {
+				if (this->mn>=MAXOBS) continue;
+				memset(this->mobs+v,0,sizeof(obsd_t));
+				this->mobs[v].time=t;
+				this->mobs[v].sat=(unsigned char)sat;
+				this->mobs[v].rcv=(unsigned char)this->mrcv;
+				this->mn++;
+			}
+			obs=this->mobs+v;
+
+			for (f=0;f<NFREQ;f++) {
+				if ((k=best[f])<0) continue;
+				sig=tbl+sigs[k]-1;
+				v=cell[k];
+				lam=CLIGHT/sig->freq;
+
+				obs->P[f]=r[j]!=0.0&&pr[v]>-1E12?r[j]+pr[v]*RANGE_MS:0.0;
+				obs->L[f]=r[j]!=0.0&&cp[v]>-1E12?(r[j]+cp[v]*RANGE_MS)/lam:0.0;
+				obs->D[f]=rr[j]>-1E12&&rrf[v]>-1E12?(float)(-(rr[j]+rrf[v])/lam):0.0f;
+
+				/* loss of lock by lock time decrease, half-cycle ambiguity */
+				prev=this->mlock[sat-1][sigs[k]-1];
+				obs->LLI[f]=((lock[v]==0.0&&prev==0.0)||lock[v]<prev?1:0)|(half[v]?2:0);
+
+				obs->SNR [f]=cnr[v]*4.0+0.5<255.0?(unsigned char)(cnr[v]*4.0+0.5):255;
+				obs->code[f]=sig->code;
+			}
+			/* lock time of all signals for the next epoch */
+			for (k=0;k<nsig;k++) {
+				if (cell[k]>=0) this->mlock[sat-1][sigs[k]-1]=lock[cell[k]];
+			}
+		}
+		if (!sync) this->mflag=1; /* last message of the epoch */
+
+		return this->mflag;
+	}
+
+	rtcm_t::~rtcm_t(){ /* destructor */
+
+	}
+
+}// namespace
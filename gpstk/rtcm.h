@@ -0,0 +1,70 @@
+/*==============================================================================
+*  This file is part of GPSTk, the GPS Toolkit.
+*
+*  Copyright (C/C++) 2020, Beihang University All Rights Reserved.
+*
+*  Author: agent, E-mail:agent@local
+*
+*  version: $Revision 1.0 $Data: 2026/10/18 00:00:00 $
+*
+*  history: 2026/10/18 	1.0 new
+						void	setreftime(gtime_t t);
+						void	setrcv(int rcv);
+						int		inputbuf(const unsigned char *buff, int n, int *nused);
+						obsd_t* getobs(int *n);
+						int		getcrcerr(void);
+*==============================================================================*/
+/**
+ * @file rtcm.h
+ * streaming rtcm 3 msm (msm4-msm7) decoder for gps, galileo and beidou.
+ */
+
+#ifndef RTCM_H_
+#define RTCM_H_
+
+#include "constant.h"
+#include "gpstime.h"
+#include "obsdata.h"
+
+#define RTCM_MAXFRM	(3+1023+3)		/* max rtcm 3 frame length (header+payload+crc) */
+#define RTCM_NSIG	32				/* number of msm signal ids */
+
+namespace gpstk{
+
+	class rtcm_t{			/* class of rtcm 3 stream decoder */
+
+		public:
+			rtcm_t();		/* constructor */
+
+			void	setreftime(gtime_t t);		/* set approx. gps time to resolve week */
+			void	setrcv(int rcv);			/* set receiver number of decoded obs */
+			int		inputbuf(const unsigned char *buff, int n, int *nused);/* input stream bytes */
+			obsd_t* getobs(int *n);				/* get the last complete epoch */
+			int		getcrcerr(void);			/* get the number of crc errors */
+
+			virtual ~rtcm_t();/* destructor */
+
+		private:
+			int decode(const unsigned char *buff, int len);	/* decode a checked frame */
+			int decode_msm(const unsigned char *buff, int len, int sys, int msm);/* decode msm4-msm7 */
+			int decode_sync(const unsigned char *buff, int len, int glo);/* sync of other msm */
+			int decode_buff(void);							/* decode frames in frame buffer */
+			gtime_t adjweek(int sys, double tow);			/* resolve week of time of week */
+			gtime_t adjday(double tod);						/* resolve day of glonass time of day */
+
+			gpstime mtime;			/* time operations */
+			gtime_t mref;			/* reference gps time for week resolution */
+			int mrcv;				/* receiver number */
+			int mn;					/* number of obs in current epoch */
+			int mflag;				/* current epoch complete flag */
+			int mnbyte;				/* number of bytes in frame buffer */
+			int mncrc;				/* number of crc errors */
+			obsd_t mobs[MAXOBS];	/* observation data of current epoch */
+			double mlock[MAXSAT][RTCM_NSIG];/* lock time per msm signal id of previous epoch (ms) */
+			unsigned char mbuff[RTCM_MAXFRM];/* frame buffer for frames split across inputs */
+
+	};//class rtcm_t
+
+}// namespace
+
+#endif // RTCM_H_
@@ -0,0 +1,522 @@
+/*==============================================================================
+*  This file is part of GPSTk, the GPS Toolkit.
+*
+*  Copyright (C/C++) 2020, Beihang University All Rights Reserved.
+*
+*  Author: agent, E-mail:agent@local
+*
+*  version: $Revision 1.0 $Data: 2026/10/18 00:00:00 $
+*
+*  history: 2026/10/18 	1.0 new
+*==============================================================================*/
+/**
+ * @file rtcmtest.cpp
+ * round-trip test of rtcm 3 msm decoder: encodes msm4/msm7 frames of gps,
+ * galileo and beidou and checks the decoded obsd_t, chunking, crc errors,
+ * week rollover, lost epoch end, epoch end by other msm, lock time and
+ * steady state allocations.
+ *
+ * requires the project constant.h, see test/readme.txt for the constants
+ * it has to define and the build command.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+
+#include "constant.h"
+#include "rtcm.h"
+#include "math.h"
+
+using namespace gpstk;
+
+static long nalloc=0; /* number of heap allocations */
+
+void* operator new(size_t size)
+{
+	nalloc++;
+	void *p=malloc(size?size:1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+void operator delete(void *p) noexcept {free(p);}
+void operator delete(void *p, size_t) noexcept {free(p);}
+
+static int nfail=0;
+
+#define CHECK(cond) do { if (!(cond)) { \
+	printf("FAIL %s:%d: %s\n",__FILE__,__LINE__,#cond); nfail++; } } while (0)
+
+#define RANGE_MS	(CLIGHT*0.001)
+
+/* msm message to encode -----------------------------------------------------*/
+struct msmspec_t{
+	int sys,msm;			/* navigation system, msm type */
+	unsigned int epoch;		/* epoch time (ms of week) */
+	int sync;				/* multiple message bit */
+	int nsat,sats[8];		/* satellite prn */
+	int nsig,sigs[4];		/* msm signal id */
+	int lock[4];			/* lock time indicator per signal */
+	unsigned char nocell;	/* satellite index without last signal (-1: all) */
+};
+
+static void setbitu(unsigned char *buff, int pos, int len, unsigned int data)
+{
+	for (int i=len-1;i>=0;i--,pos++) {
+		unsigned char mask=(unsigned char)(1u<<(7-pos%8));
+		if ((data>>i)&1u) buff[pos/8]|=mask; else buff[pos/8]&=~mask;
+	}
+}
+static void setbits(unsigned char *buff, int pos, int len, int data)
+{
+	setbitu(buff,pos,len,(unsigned int)data&(len<32?(1u<<len)-1:~0u));
+}
+
+/* bit by bit crc-24q, independent of the table driven decoder ---------------*/
+static unsigned int crc24q_ref(const unsigned char *buff, int len)
+{
+	unsigned int crc=0;
+
+	for (int i=0;i<len;i++) {
+		crc^=(unsigned int)buff[i]<<16;
+		for (int j=0;j<8;j++) {
+			crc<<=1; if (crc&0x1000000) crc^=0x1864CFB;
+		}
+	}
+	return crc&0xFFFFFF;
+}
+
+/* test values per satellite j and signal k ----------------------------------*/
+static int    rng_int (int j)        {return 68+j;}
+static int    rng_mod (int j)        {return 100+37*j;}
+static int    rate_int(int j)        {return -700+113*j;}
+static int    fine_pr (int j, int k) {return -3000+101*j+257*k;}
+static int    fine_cp (int j, int k) {return  5000-97*j+311*k;}
+static int    fine_rr (int j, int k) {return -1200+13*j+29*k;}
+static int    cnr_raw (int j, int k, int msm) {return msm==4?40+j+k:(40+j+k)*16+3;}
+
+static int has_cell(const msmspec_t *s, int j, int k)
+{
+	return !(j==s->nocell&&k==s->nsig-1);
+}
+
+/* encode msm frame ------------------------------------------------------------
+* args   : msmspec_t *s     I   message spec
+*          unsigned char *buff O rtcm 3 frame with crc
+* return : frame length (bytes)
+*-----------------------------------------------------------------------------*/
+static int encode_msm(const msmspec_t *s, unsigned char *buff)
+{
+	int type=(s->sys==SYS_GPS?1070:(s->sys==SYS_GAL?1090:1120))+s->msm;
+	int i=24,j,k,ext=s->msm==7,ncell=0,len;
+
+	memset(buff,0,RTCM_MAXFRM);
+	setbitu(buff,i,12,type);     i+=12;
+	setbitu(buff,i,12,0);        i+=12;
+	setbitu(buff,i,30,s->epoch); i+=30;
+	setbitu(buff,i,1,s->sync);   i+=1;
+	i+=3+7+2+2+1+3;
+	for (j=1;j<=64;j++) {
+		for (k=0;k<s->nsat;k++) if (s->sats[k]==j) break;
+		setbitu(buff,i++,1,k<s->nsat);
+	}
+	for (j=1;j<=32;j++) {
+		for (k=0;k<s->nsig;k++) if (s->sigs[k]==j) break;
+		setbitu(buff,i++,1,k<s->nsig);
+	}
+	for (j=0;j<s->nsat;j++) for (k=0;k<s->nsig;k++) {
+		setbitu(buff,i++,1,has_cell(s,j,k)); ncell+=has_cell(s,j,k);
+	}
+	for (j=0;j<s->nsat;j++) {setbitu(buff,i,8,rng_int(j)); i+=8;}
+	if (ext) i+=4*s->nsat;
+	for (j=0;j<s->nsat;j++) {setbitu(buff,i,10,rng_mod(j)); i+=10;}
+	if (ext) for (j=0;j<s->nsat;j++) {setbits(buff,i,14,rate_int(j)); i+=14;}
+
+#define CELLS(stmt) for (j=0;j<s->nsat;j++) for (k=0;k<s->nsig;k++) if (has_cell(s,j,k)) {stmt;}
+	if (!ext) {
+		CELLS(setbits(buff,i,15,fine_pr(j,k)); i+=15)
+		CELLS(setbits(buff,i,22,fine_cp(j,k)); i+=22)
+		CELLS(setbitu(buff,i,4,s->lock[k]); i+=4)
+		CELLS(setbitu(buff,i,1,0); i+=1)
+		CELLS(setbitu(buff,i,6,cnr_raw(j,k,4)); i+=6)
+	}
+	else {
+		CELLS(setbits(buff,i,20,fine_pr(j,k)); i+=20)
+		CELLS(setbits(buff,i,24,fine_cp(j,k)); i+=24)
+		CELLS(setbitu(buff,i,10,s->lock[k]); i+=10)
+		CELLS(setbitu(buff,i,1,0); i+=1)
+		CELLS(setbitu(buff,i,10,cnr_raw(j,k,7)); i+=10)
+		CELLS(setbits(buff,i,15,fine_rr(j,k)); i+=15)
+	}
+#undef CELLS
+	len=(i+7)/8; /* header + payload */
+	buff[0]=0xD3;
+	setbitu(buff,14,10,len-3);
+	setbitu(buff,len*8,24,crc24q_ref(buff,len));
+	return len+3;
+}
+
+/* encode msm header without satellites ----------------------------------------
+* args   : int    type      I   message number
+*          unsigned int epoch I epoch time field (DF004,DF034,...)
+*          int    sync      I   multiple message bit
+*          unsigned char *buff O rtcm 3 frame with crc
+* return : frame length (bytes)
+*-----------------------------------------------------------------------------*/
+static int encode_head(int type, unsigned int epoch, int sync, unsigned char *buff)
+{
+	int i=24,len;
+
+	memset(buff,0,64);
+	setbitu(buff,i,12,type);  i+=12;
+	setbitu(buff,i,12,0);     i+=12;
+	setbitu(buff,i,30,epoch); i+=30;
+	setbitu(buff,i,1,sync);   i+=1;
+	i+=3+7+2+2+1+3+64+32;
+	len=(i+7)/8;
+	buff[0]=0xD3;
+	setbitu(buff,14,10,len-3);
+	setbitu(buff,len*8,24,crc24q_ref(buff,len));
+	return len+3;
+}
+
+/* check decoded observation data against spec ---------------------------------
+* args   : msmspec_t *s     I   message spec
+*          obsd_t *obs      I   decoded observation data of the epoch
+*          int    n         I   number of observation data
+*          int    satoff    I   satellite number offset of the system
+*          double *freq     I   carrier frequency per signal of spec (Hz)
+*          int    *idx      I   obsd_t frequency index per signal of spec
+*-----------------------------------------------------------------------------*/
+static void check_obs(const msmspec_t *s, const obsd_t *obs, int n, int satoff,
+	const double *freq, const int *idx)
+{
+	int ext=s->msm==7;
+
+	for (int j=0;j<s->nsat;j++) {
+		const obsd_t *o=NULL;
+		double r=(rng_int(j)+rng_mod(j)/1024.0)*RANGE_MS;
+
+		for (int q=0;q<n;q++) if (obs[q].sat==satoff+s->sats[j]) o=obs+q;
+		CHECK(o!=NULL);
+		if (!o) continue;
+
+		for (int k=0;k<s->nsig;k++) {
+			int f=idx[k];
+			double lam=CLIGHT/freq[k];
+			double P=r+fine_pr(j,k)*(ext?ldexp(1.0,-29):ldexp(1.0,-24))*RANGE_MS;
+			double L=(r+fine_cp(j,k)*(ext?ldexp(1.0,-31):ldexp(1.0,-29))*RANGE_MS)/lam;
+			double cnr=ext?cnr_raw(j,k,7)*0.0625:cnr_raw(j,k,4);
+
+			if (!has_cell(s,j,k)) {
+				CHECK(o->P[f]==0.0&&o->L[f]==0.0);
+				continue;
+			}
+			CHECK(fabs(o->P[f]-P)<1E-4);
+			CHECK(fabs(o->L[f]-L)<1E-4);
+			CHECK(o->SNR[f]==(unsigned char)(cnr*4.0+0.5));
+			if (ext) {
+				double D=-(rate_int(j)+fine_rr(j,k)*0.0001)/lam;
+				CHECK(fabs(o->D[f]-D)<1E-3);
+			}
+			else CHECK(o->D[f]==0.0f);
+		}
+	}
+}
+
+/* input stream in chunks ------------------------------------------------------
+* args   : rtcm_t *rtcm     IO  decoder
+*          unsigned char *buff I stream
+*          int    n         I   stream length
+*          int    chunk     I   chunk size (bytes)
+*          obsd_t *obs      O   observation data of all epochs
+*          int    *nobs     O   number of observation data per epoch
+* return : number of epochs
+*-----------------------------------------------------------------------------*/
+static int input_stream(rtcm_t *rtcm, const unsigned char *buff, int n, int chunk,
+	obsd_t *obs, int *nobs)
+{
+	int pos=0,nep=0,nall=0;
+
+	while (pos<n) {
+		int len=chunk<n-pos?chunk:n-pos;
+		const unsigned char *p=buff+pos;
+
+		pos+=len;
+		while (len>0) {
+			int nused,m;
+			int stat=rtcm->inputbuf(p,len,&nused);
+			p+=nused; len-=nused;
+			if (!stat) continue;
+			obsd_t *o=rtcm->getobs(&m);
+			memcpy(obs+nall,o,sizeof(obsd_t)*m);
+			nall+=m; nobs[nep++]=m;
+		}
+	}
+	return nep;
+}
+
+static const double freq_gps[]={FREQ1,FREQ2},freq_gal[]={FREQ1,FREQ7};
+static const double freq_cmp[]={FREQ1_CMP,FREQ2_CMP};
+static const int idx12[]={0,1};
+static const int sat_gal=NSATGPS+NSATGLO,sat_cmp=NSATGPS+NSATGLO+NSATGAL+NSATQZS;
+
+/* msm4/msm7 round trip of gps, galileo and beidou in one epoch --------------*/
+static void test_roundtrip(void)
+{
+	gpstime gt;
+	static unsigned char buff[8192];
+	static obsd_t obs[256];
+	int nobs[16],n,msm;
+
+	for (msm=4;msm<=7;msm+=3) {
+		msmspec_t gps={SYS_GPS,msm,345600000,1,3,{3,17,32},2,{2,10},{5,5},1};
+		msmspec_t gal={SYS_GAL,msm,345600000,1,2,{1,36},2,{2,14},{5,5},(unsigned char)-1};
+		msmspec_t cmp={SYS_CMP,msm,345600000-14000,0,3,{6,36,63},2,{2,14},{5,5},(unsigned char)-1};
+
+		if (msm==7) gps.lock[0]=gps.lock[1]=gal.lock[0]=gal.lock[1]=cmp.lock[0]=cmp.lock[1]=500;
+
+		n =encode_msm(&gps,buff);
+		n+=encode_msm(&gal,buff+n);
+		n+=encode_msm(&cmp,buff+n);
+
+		for (int chunk=1;chunk<=n;chunk=chunk==1?7:(chunk==7?n:n+1)) {
+			rtcm_t rtcm;
+			int w;
+
+			rtcm.setreftime(gt.gpst2time(2200,345000.0));
+			CHECK(input_stream(&rtcm,buff,n,chunk,obs,nobs)==1);
+			CHECK(nobs[0]==8);
+			CHECK(rtcm.getcrcerr()==0);
+			check_obs(&gps,obs,nobs[0],0,freq_gps,idx12);
+			check_obs(&gal,obs,nobs[0],sat_gal,freq_gal,idx12);
+			check_obs(&cmp,obs,nobs[0],sat_cmp,freq_cmp,idx12);
+			CHECK(fabs(gt.time2gpst(obs[0].time,&w)-345600.0)<1E-9&&w==2200);
+			CHECK(fabs(gt.timediff(obs[7].time,obs[0].time))<1E-9);
+			CHECK(obs[0].code[0]==CODE_L1C&&obs[0].code[1]==CODE_L2W);
+		}
+	}
+}
+
+/* crc error and stray preamble at any chunking ------------------------------*/
+static void test_crcerr(void)
+{
+	gpstime gt;
+	static unsigned char buff[8192];
+	static obsd_t obs[256];
+	int nobs[16],n=0,bad=0,nep;
+	msmspec_t spec={SYS_GPS,7,1000,0,2,{5,9},2,{2,10},{300,300},(unsigned char)-1};
+
+	buff[n++]=0xD3; buff[n++]=0x00; /* stray preamble before a real frame */
+	for (int e=0;e<4;e++) {
+		spec.epoch=1000*(e+1);
+		if (e==2) bad=n;
+		n+=encode_msm(&spec,buff+n);
+	}
+	buff[bad+20]^=0x10; /* corrupt epoch 3 */
+
+	for (int chunk=1;chunk<=n;chunk++) {
+		rtcm_t rtcm;
+		int w;
+
+		rtcm.setreftime(gt.gpst2time(2200,0.0));
+		nep=input_stream(&rtcm,buff,n,chunk,obs,nobs);
+		CHECK(nep==3);
+		CHECK(rtcm.getcrcerr()>=1);
+		if (nep==3) {
+			CHECK(fabs(gt.time2gpst(obs[nobs[0]+nobs[1]].time,&w)-4.0)<1E-9);
+		}
+	}
+}
+
+/* week rollover of gps, galileo and beidou time -----------------------------*/
+static void test_rollover(void)
+{
+	gpstime gt;
+	static unsigned char buff[4096];
+	int n,m;
+	const int sys[]={SYS_GPS,SYS_GAL,SYS_CMP};
+
+	for (int s=0;s<3;s++) {
+		for (int dir=0;dir<2;dir++) {
+			/* reference at end of week, epoch at start of next week and reverse */
+			double tref=dir?0.5:604799.5,tow=dir?604799.0:1.0;
+			int week=dir?2199:2201;
+			msmspec_t spec={sys[s],4,0,0,1,{11},1,{2},{5},(unsigned char)-1};
+			rtcm_t rtcm;
+			obsd_t *obs;
+			gtime_t t;
+
+			spec.epoch=(unsigned int)(tow*1000.0);
+			n=encode_msm(&spec,buff);
+			rtcm.setreftime(sys[s]==SYS_CMP?gt.bdt2gpst(gt.bdt2time(2200-1356,tref)):
+				(sys[s]==SYS_GAL?gt.gst2time(2200-1024,tref):gt.gpst2time(2200,tref)));
+			CHECK(rtcm.inputbuf(buff,n,NULL)==1);
+			obs=rtcm.getobs(&m);
+			CHECK(m==1);
+			if (sys[s]==SYS_GPS) t=gt.gpst2time(week,tow);
+			else if (sys[s]==SYS_GAL) t=gt.gst2time(week-1024,tow);
+			else t=gt.bdt2gpst(gt.bdt2time(week-1356,tow));
+			CHECK(fabs(gt.timediff(obs[0].time,t))<1E-9);
+		}
+	}
+}
+
+/* epoch completed by the next epoch time when sync=0 message was lost -------*/
+static void test_lostsync(void)
+{
+	gpstime gt;
+	static unsigned char buff[4096];
+	static obsd_t obs[256];
+	int nobs[16],n=0,w;
+	msmspec_t spec={SYS_GPS,4,0,1,2,{1,2},1,{2},{5},(unsigned char)-1};
+
+	for (int e=0;e<3;e++) {
+		spec.epoch=1000*(e+1);
+		spec.sync=e==2?0:1; /* epoch 1,2 without last message */
+		n+=encode_msm(&spec,buff+n);
+	}
+	for (int chunk=1;chunk<=n;chunk=chunk==1?n:n+1) {
+		rtcm_t rtcm;
+
+		rtcm.setreftime(gt.gpst2time(2200,0.0));
+		CHECK(input_stream(&rtcm,buff,n,chunk,obs,nobs)==3);
+		CHECK(nobs[0]==2&&nobs[1]==2&&nobs[2]==2);
+		CHECK(fabs(gt.time2gpst(obs[0].time,&w)-1.0)<1E-9);
+		CHECK(fabs(gt.time2gpst(obs[2].time,&w)-2.0)<1E-9);
+		CHECK(fabs(gt.time2gpst(obs[4].time,&w)-3.0)<1E-9);
+	}
+}
+
+/* epoch completed by sync=0 of glonass or qzss msm not decoded ---------------*/
+static void test_othersync(void)
+{
+	gpstime gt;
+	static unsigned char buff[4096];
+	static obsd_t obs[256];
+	int nobs[16],n,m,w;
+	msmspec_t spec={SYS_GPS,7,345600000,1,2,{4,8},1,{2},{500},(unsigned char)-1};
+	gtime_t t=gt.gpst2time(2200,345600.0);
+	double tow;
+	unsigned int dow,tod;
+
+	/* glonass epoch time: day of week + time of day in UTC+3h */
+	tow=gt.time2gpst(gt.timeadd(gt.gpst2utc(t),10800.0),&w);
+	dow=(unsigned int)(tow/86400.0);
+	tod=(unsigned int)((tow-dow*86400.0)*1000.0+0.5);
+
+	for (int last=0;last<2;last++) {
+		n =encode_msm(&spec,buff);
+		n+=last?encode_head(1117,345600000,0,buff+n):encode_head(1084,(dow<<27)|tod,0,buff+n);
+
+		for (int chunk=1;chunk<=n;chunk=chunk==1?n:n+1) {
+			rtcm_t rtcm;
+
+			rtcm.setreftime(gt.gpst2time(2200,345000.0));
+			CHECK(input_stream(&rtcm,buff,n,chunk,obs,nobs)==1);
+			CHECK(nobs[0]==2);
+			CHECK(fabs(gt.timediff(obs[0].time,t))<1E-9);
+		}
+		/* completed within the same input */
+		rtcm_t rtcm;
+		rtcm.setreftime(gt.gpst2time(2200,345000.0));
+		CHECK(rtcm.inputbuf(buff,n,NULL)==1);
+		rtcm.getobs(&m);
+		CHECK(m==2);
+	}
+}
+
+/* signal priority and lock time per signal ----------------------------------*/
+static void test_lock(void)
+{
+	gpstime gt;
+	static unsigned char buff[4096];
+	int n,m;
+	msmspec_t spec={SYS_GPS,7,0,0,1,{7},3,{2,10,16},{500,447,300},(unsigned char)-1};
+	rtcm_t rtcm;
+	obsd_t *obs;
+
+	rtcm.setreftime(gt.gpst2time(2200,0.0));
+	for (int e=0;e<3;e++) {
+		spec.epoch=1000*(e+1);
+		if (e==2) spec.lock[1]=100; /* 2W lock time decreased */
+		n=encode_msm(&spec,buff);
+		CHECK(rtcm.inputbuf(buff,n,NULL)==1);
+		obs=rtcm.getobs(&m);
+		CHECK(m==1);
+		CHECK(obs[0].code[0]==CODE_L1C&&obs[0].code[1]==CODE_L2W); /* 2W over 2L */
+		CHECK(obs[0].LLI[0]==0);
+		CHECK(obs[0].LLI[1]==(e==2?1:0));
+	}
+}
+
+/* short frame with valid crc must not read past the frame -------------------*/
+static void test_short(void)
+{
+	unsigned char frm[9]={0xD3,0x00,0x03};
+	int m;
+	rtcm_t rtcm;
+
+	frm[3]=(unsigned char)(1077>>4); frm[4]=(unsigned char)((1077&0xF)<<4);
+	setbitu(frm,48,24,crc24q_ref(frm,6));
+	CHECK(rtcm.inputbuf(frm,9,NULL)==0);
+	rtcm.getobs(&m);
+	CHECK(m==0);
+}
+
+/* steady state allocations, throughput printed for information -------------*/
+static void test_throughput(void)
+{
+	gpstime gt;
+	static unsigned char buff[32768];
+	int n=0,nep=0,nmsg=0;
+	long nalloc0;
+	clock_t t0;
+	double sec;
+	msmspec_t spec[3]={
+		{SYS_GPS,7,0,1,8,{1,3,5,7,9,11,13,15},3,{2,10,22},{500,500,500},(unsigned char)-1},
+		{SYS_GAL,7,0,1,8,{1,3,5,7,9,11,13,15},3,{2,14,22},{500,500,500},(unsigned char)-1},
+		{SYS_CMP,7,0,0,8,{1,3,5,7,9,11,13,15},3,{2,8,14},{500,500,500},(unsigned char)-1}
+	};
+	rtcm_t rtcm;
+
+	for (int e=0;e<10;e++) for (int s=0;s<3;s++) {
+		spec[s].epoch=1000*e+(s==2?604800000-14000:0);
+		n+=encode_msm(spec+s,buff+n);
+	}
+	rtcm.setreftime(gt.gpst2time(2200,0.0));
+	nalloc0=nalloc;
+	t0=clock();
+	for (int loop=0;loop<20000;loop++) {
+		rtcm.setreftime(gt.gpst2time(2200,0.0));
+		const unsigned char *p=buff;
+		int len=n,nused;
+		while (len>0) {
+			nep+=rtcm.inputbuf(p,len,&nused);
+			p+=nused; len-=nused;
+		}
+		nmsg+=30;
+	}
+	sec=(double)(clock()-t0)/CLOCKS_PER_SEC;
+	CHECK(nalloc==nalloc0);
+	CHECK(nep==20000*10);
+	printf("throughput: %d msm7 messages in %.3f s (%.0f msg/s, info only)\n",nmsg,sec,
+		sec>0.0?nmsg/sec:0.0);
+}
+
+int main(void)
+{
+	test_roundtrip();
+	test_crcerr();
+	test_rollover();
+	test_lostsync();
+	test_othersync();
+	test_lock();
+	test_short();
+	test_throughput();
+
+	printf("%s: %d failure(s)\n",nfail?"FAILED":"PASSED",nfail);
+	return nfail?1:0;
+}